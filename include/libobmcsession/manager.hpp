@@ -5,9 +5,15 @@
 
 #pragma once
 
+#include <libobmcsession/scrub.hpp>
+#include <libobmcsession/statistics.hpp>
+#include <libobmcsession/tombstone.hpp>
 #include <sdbusplus/bus.hpp>
 #include <xyz/openbmc_project/Session/Item/server.hpp>
 
+#include <chrono>
+#include <optional>
+
 namespace obmc
 {
 namespace session
@@ -54,7 +60,9 @@ class SessionManager final : public std::enable_shared_from_this<SessionManager>
                    const SessionType type) :
         bus(bus),
         slug(slug), serviceName(serviceNameStartSegment + slug), type(type)
-    {}
+    {
+        resetStatistics();
+    }
 
     /**
      * @brief Create a session and publish into the dbus.
@@ -100,6 +108,47 @@ class SessionManager final : public std::enable_shared_from_this<SessionManager>
                              const uint32_t remoteAddress,
                              SessionCleanupFn&& cleanupFn);
 
+    /**
+     * @brief Return the opened session of the same client or create a new one
+     *        and publish it into the dbus.
+     *
+     * The client is identified by the owner user name, the remote address and
+     * the optional client token, the session type is implied by the manager.
+     * The reused session is shared by all the clients with the same identity,
+     * thus removing it closes the session of all of them. A session without
+     * an owner user name is never reused, a new one is always created.
+     *
+     * @param userName              - the owner user name
+     * @param remoteAddress         - the IP address of the session initiator.
+     * @param clientToken           - the optional client specific token to
+     *                                distinguish the clients of the same user
+     *                                and address.
+     *
+     * @return SessionIdentifier    - unique session ID
+     */
+    SessionIdentifier createOrReuse(const std::string& userName,
+                                    const uint32_t remoteAddress,
+                                    const std::string& clientToken = {});
+
+    /**
+     * @brief Return the opened session of the same client or create a new one
+     *        with cleanup callback on the session destroy.
+     *
+     * @param userName              - the owner user name
+     * @param remoteAddress         - the IP address of the session initiator.
+     * @param clientToken           - the client specific token.
+     * @param cleanupFn             - the callback to cleanup session on
+     *                                destroy, it is chained to the callbacks
+     *                                of the previous clients if an existing
+     *                                session is reused.
+     *
+     * @return SessionIdentifier    - unique session ID
+     */
+    SessionIdentifier createOrReuse(const std::string& userName,
+                                    const uint32_t remoteAddress,
+                                    const std::string& clientToken,
+                                    SessionCleanupFn&& cleanupFn);
+
     /**
      * @brief Set the Session Metadata object
      *
@@ -122,8 +171,22 @@ class SessionManager final : public std::enable_shared_from_this<SessionManager>
      */
     bool remove(SessionIdentifier sessionId);
 
+    /**
+     * @brief Remove a dbus session object from storage and unpublish it from
+     *        dbus remembering the way the session has been closed.
+     *
+     * @param sessionId     - unique session ID to remove from storage
+     * @param reason        - the way the session is closed
+     *
+     * @return true         - success
+     * @return false        - fail
+     */
+    bool remove(SessionIdentifier sessionId, SessionCloseReason reason);
+
     /**
      * @brief Remove all sessions associated with the specified user.
+     *        The closed sessions of the current manager are remembered as
+     *        revoked.
      *
      * @param userName      - username to close appropriate sessions
      *
@@ -131,11 +194,13 @@ class SessionManager final : public std::enable_shared_from_this<SessionManager>
      *
      * @return std::size_t  - count of closed sessions
      */
-    std::size_t removeAll(const std::string& userName) const;
+    std::size_t removeAll(const std::string& userName);
 
     /**
      * @brief Remove all sessions which have been opened from the specified IPv4
      *        address.
+     *        The closed sessions of the current manager are remembered as
+     *        revoked.
      *
      * @param remoteAddress - the IP address of the session initiator..
      *
@@ -143,10 +208,12 @@ class SessionManager final : public std::enable_shared_from_this<SessionManager>
      *
      * @return std::size_t  - count of closed sessions
      */
-    std::size_t removeAll(uint32_t remoteAddress) const;
+    std::size_t removeAll(uint32_t remoteAddress);
 
     /**
      * @brief Remove all sessions of specified type.
+     *        The closed sessions of the current manager are remembered as
+     *        revoked.
      *
      * @param type         - the type of session to close.
      *
@@ -154,16 +221,69 @@ class SessionManager final : public std::enable_shared_from_this<SessionManager>
      *
      * @return std::size_t - count of closed sessions
      */
-    std::size_t removeAll(SessionType type) const;
+    std::size_t removeAll(SessionType type);
 
     /**
      * @brief Unconditional removes all opened sessions.
+     *        The closed sessions of the current manager are remembered as
+     *        revoked.
      *
      * @throw std::runtime_error not implemented
      *
      * @return std::size_t - count of closed sessions
      */
-    std::size_t removeAll() const;
+    std::size_t removeAll();
+
+    /**
+     * @brief Find the recently closed session to tell the way it has been
+     *        closed. Only the last SessionTombstoneRing::capacity closed
+     *        sessions are kept.
+     *
+     * @param sessionId     - the session identifier to look up.
+     *
+     * @return std::optional<SessionTombstone> - the closed session record,
+     *         std::nullopt if the session is either alive, closed long ago
+     *         or has never existed.
+     */
+    std::optional<SessionTombstone>
+        findClosedSession(SessionIdentifier sessionId) const;
+
+    /**
+     * @brief Get a snapshot of the sessions statistics collected since the
+     *        manager construction or the last statistics reset.
+     *
+     * @return SessionStatistics - the statistics of the sessions of the
+     *                             manager type.
+     */
+    SessionStatistics getStatistics() const;
+
+    /**
+     * @brief Drop the collected sessions statistics and start the new
+     *        observation period.
+     */
+    void resetStatistics();
+
+    /**
+     * @brief Check the next slice of the opened sessions for consistency
+     *        between the local storage and the published dbus objects and
+     *        repair found mismatches. Intended to be called on idle, each call
+     *        continues from the session the previous one has stopped at.
+     *
+     * Each stored session is checked to be known by the object mapper and is
+     * announced again otherwise. Once all the stored sessions are checked,
+     * the session objects the mapper lists for the manager service but which
+     * aren't stored anymore are removed from the mapper. That takes a single
+     * `GetSubTree` call limited to the manager object path per pass. The step
+     * is stopped without any repair if the mapper fails for a reason other
+     * than an unknown object. The next pass isn't started until the budget
+     * pass interval elapses since the end of the previous one, the step
+     * returns without any check meanwhile.
+     *
+     * @param budget        - limits of the current step.
+     *
+     * @return ScrubReport  - the summary of checked and repaired sessions.
+     */
+    ScrubReport scrub(const ScrubBudget& budget = {});
 
   protected:
     friend class SessionItem;
@@ -226,7 +346,9 @@ class SessionManager final : public std::enable_shared_from_this<SessionManager>
     const DBusSubTreeOut findSessionItemObjects() const;
 
     /**
-     * @brief Close session by specified object path
+     * @brief Close session by specified object path. The session owned by the
+     *        current manager is removed from the storage directly and is
+     *        remembered as revoked.
      *
      * @param serviceName   - session object service name
      * @param objectPath    - session object path to close
@@ -234,10 +356,24 @@ class SessionManager final : public std::enable_shared_from_this<SessionManager>
      * @throw std::exception failure on deleting item object
      */
     void callCloseSession(const std::string& serviceName,
-                          const std::string& objectPath) const;
+                          const std::string& objectPath);
+
+    /**
+     * @brief Find the stored session of the current manager by the object
+     *        path.
+     *
+     * @param objectPath    - session object path
+     *
+     * @return std::optional<SessionIdentifier> - the session identifier,
+     *         std::nullopt if the object isn't a stored session of the current
+     *         manager.
+     */
+    std::optional<SessionIdentifier>
+        findOwnSessionId(const std::string& objectPath) const;
 
     /**
-     * @brief Retrieve session details
+     * @brief Retrieve session details. The details of the session owned by
+     *        the current manager are taken from the storage.
      *
      * @param serviceName   - session object service name
      * @param objectPath    - session object path
@@ -248,6 +384,51 @@ class SessionManager final : public std::enable_shared_from_this<SessionManager>
         getSessionDetails(const std::string& serviceName,
                           const std::string& objectPath) const;
 
+    /**
+     * @brief Account the session activation, i.e. the first assignment of the
+     *        session metadata.
+     *
+     * @param session       - the activated session item.
+     */
+    void sessionActivated(SessionItem& session);
+
+    /**
+     * @brief Exclude the session from reusing by the subsequent
+     *        createOrReuse() calls.
+     *
+     * @param sessionId     - session identifier.
+     */
+    void forgetClientFingerprint(SessionIdentifier sessionId);
+
+    /**
+     * @brief Check whether the object mapper knows the session object of the
+     *        current manager service.
+     *
+     * @param objectPath    - session object path
+     * @param timeoutUs     - the mapper reply timeout in microseconds
+     *
+     * @throw sdbusplus::exception::exception failure on the mapper request
+     *        other than the unknown object
+     *
+     * @return true         - the session object is registered in the mapper
+     * @return false        - the session object is unknown
+     */
+    bool isSessionObjectMapped(const std::string& objectPath,
+                               uint64_t timeoutUs) const;
+
+    /**
+     * @brief Find the session objects under the current manager object path.
+     *
+     * @param timeoutUs     - the mapper reply timeout in microseconds
+     *
+     * @throw sdbusplus::exception::exception failure on the mapper request
+     *        other than the unknown object
+     *
+     * @return const DBusSubTreeOut - session objects dictionary with
+     *         appropriate dbus Service, Interfaces.
+     */
+    const DBusSubTreeOut findOwnSessionItemObjects(uint64_t timeoutUs) const;
+
   private:
     sdbusplus::bus::bus& bus;
     const std::string slug;
@@ -256,6 +437,32 @@ class SessionManager final : public std::enable_shared_from_this<SessionManager>
 
     using SessionItemDict = std::map<SessionIdentifier, SessionItemUni>;
     SessionItemDict sessionItems;
+
+    using ClientFingerprint = std::tuple<std::string, uint32_t, std::string>;
+    using ReusableSessionDict = std::map<ClientFingerprint, SessionIdentifier>;
+    using SessionFingerprintDict =
+        std::map<SessionIdentifier, ReusableSessionDict::iterator>;
+    ReusableSessionDict reusableSessions;
+    SessionFingerprintDict sessionFingerprints;
+
+    /**
+     * @brief Find the opened session of the client to reuse.
+     *
+     * @param fingerprint   - the client identity.
+     *
+     * @return std::optional<SessionIdentifier> - the session identifier,
+     *         std::nullopt if the client has no reusable session.
+     */
+    std::optional<SessionIdentifier>
+        findReusableSession(const ClientFingerprint& fingerprint) const;
+
+    SessionStatistics statistics;
+    SessionTombstoneRing tombstones;
+    SessionIdentifier scrubCursor = 0;
+    bool scrubOrphansPending = false;
+    bool scrubPassInProgress = false;
+    std::optional<std::chrono::steady_clock::time_point> scrubPassEnd;
+    std::chrono::steady_clock::time_point statisticsSince;
 };
 } // namespace session
 } // namespace obmc
@@ -0,0 +1,62 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2021 YADRO.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace obmc
+{
+namespace session
+{
+
+/**
+ * @brief Limits of a single consistency scrub step.
+ *
+ * The step doesn't start the next check as soon as any of the limits is
+ * reached.
+ */
+struct ScrubBudget
+{
+    /** @brief Max count of the sessions to check */
+    std::size_t sessions = 8;
+    /** @brief Max count of the dbus calls to make */
+    std::size_t roundTrips = 8;
+    /** @brief Max time to spend */
+    std::chrono::microseconds duration = std::chrono::milliseconds(2);
+    /**
+     * @brief The mapper reply timeout of a single call, not less than
+     *        minCallTimeout is used.
+     */
+    std::chrono::microseconds callTimeout = std::chrono::milliseconds(500);
+    /** @brief Min time from the end of a pass till the start of the next one */
+    std::chrono::seconds passInterval = std::chrono::minutes(1);
+
+    static constexpr std::chrono::microseconds minCallTimeout =
+        std::chrono::milliseconds(50);
+};
+
+/**
+ * @brief Outcome of a single consistency scrub step.
+ */
+struct ScrubReport
+{
+    std::size_t checked = 0;
+    std::size_t roundTrips = 0;
+    /** @brief Count of sessions announced again since the mapper lost them */
+    std::size_t republished = 0;
+    /** @brief Count of session objects the mapper listed but not stored */
+    std::size_t orphansRemoved = 0;
+    /** @brief The step has been stopped since the budget is exhausted */
+    bool budgetExhausted = false;
+    /** @brief The step has been stopped due to the mapper failure */
+    bool mapperUnavailable = false;
+    /** @brief The step has finished the pass over the sessions table */
+    bool passCompleted = false;
+};
+
+} // namespace session
+} // namespace obmc
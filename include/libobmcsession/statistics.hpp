@@ -0,0 +1,100 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2021 YADRO.
+ */
+
+#pragma once
+
+#include <xyz/openbmc_project/Session/Item/server.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace obmc
+{
+namespace session
+{
+
+/**
+ * @brief Histogram of session durations.
+ *
+ * The bucket `i` counts durations shorter than 2^i milliseconds which don't
+ * fit into the previous bucket, so the buckets cover the range from a
+ * millisecond up to about 18 hours. The last bucket counts all the longer
+ * durations.
+ */
+class DurationHistogram
+{
+  public:
+    using Duration = std::chrono::milliseconds;
+    static constexpr std::size_t bucketsCount = 28;
+    using Buckets = std::array<std::uint64_t, bucketsCount>;
+
+    /**
+     * @brief Account the specified duration.
+     *
+     * @param duration  - the duration to account.
+     */
+    void record(Duration duration);
+
+    /**
+     * @brief Get the upper bound of the specified bucket.
+     *
+     * @param bucket    - the bucket index.
+     *
+     * @return Duration - exclusive upper bound of the bucket, Duration::max()
+     *                    for the last one.
+     */
+    static Duration bucketUpperBound(std::size_t bucket);
+
+    /**
+     * @brief Get the mean of all accounted durations.
+     *
+     * @return Duration - the mean duration, zero if nothing is accounted.
+     */
+    Duration mean() const;
+
+    Buckets buckets{};
+    std::uint64_t count = 0;
+    Duration total = Duration::zero();
+    /** @brief The shortest accounted duration, zero if nothing is accounted */
+    Duration min = Duration::zero();
+    /** @brief The longest accounted duration, zero if nothing is accounted */
+    Duration max = Duration::zero();
+};
+
+/**
+ * @brief Snapshot of the sessions statistics of a single session type.
+ */
+struct SessionStatistics
+{
+    using SessionType =
+        sdbusplus::xyz::openbmc_project::Session::server::Item::Type;
+
+    /**
+     * @brief Get the session churn rate.
+     *
+     * @return double - count of closed sessions per minute within the
+     *                  observation period.
+     */
+    double churnRate() const;
+
+    SessionType type{};
+    /** @brief Time from the session creation till the session removal */
+    DurationHistogram lifetime;
+    /** @brief Time from the session creation till the metadata is set */
+    DurationHistogram activation;
+    std::uint64_t created = 0;
+    std::uint64_t activated = 0;
+    std::uint64_t closed = 0;
+    /** @brief Count of create requests served by an already opened session */
+    std::uint64_t reused = 0;
+    /** @brief Count of sessions opened at the snapshot moment */
+    std::uint64_t active = 0;
+    /** @brief Period since the statistics collection has been started */
+    std::chrono::seconds observed = std::chrono::seconds::zero();
+};
+
+} // namespace session
+} // namespace obmc
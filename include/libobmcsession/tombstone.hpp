@@ -0,0 +1,120 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ * Copyright (C) 2021 YADRO.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace obmc
+{
+namespace session
+{
+
+/**
+ * @brief The way the session has been closed.
+ */
+enum class SessionCloseReason : std::uint8_t
+{
+    /** @brief Removed by the session owner without the reason specified */
+    removed,
+    /** @brief Expired by the session owner on the inactivity timeout */
+    expired,
+    /** @brief Closed by the session owner on the client logout request */
+    loggedOut,
+    /**
+     * @brief Deleted via the `xyz.openbmc_project.Object.Delete` method.
+     *        The bulk closing requested by another service is delivered the
+     *        same way, so it is recorded with this reason as well.
+     */
+    deleted,
+    /**
+     * @brief Closed by the bulk SessionManager::removeAll() request of the
+     *        current manager.
+     */
+    revoked,
+};
+
+/**
+ * @brief Record of the recently closed session.
+ */
+struct SessionTombstone
+{
+    std::uint64_t sessionId;
+    SessionCloseReason reason;
+    std::chrono::steady_clock::time_point closedAt;
+};
+
+/**
+ * @brief Fixed-size ring of the recently closed sessions.
+ *
+ * The oldest record is overwritten once the ring is full. Records are indexed
+ * by an open-addressed hash table which is kept at most half full, so both
+ * recording and lookup don't allocate and take constant time.
+ */
+class SessionTombstoneRing
+{
+    static constexpr std::size_t indexBits = 9;
+    static constexpr std::size_t indexSize = 1U << indexBits;
+    static constexpr std::uint16_t emptySlot = UINT16_MAX;
+
+  public:
+    using SessionIdentifier = std::uint64_t;
+    static constexpr std::size_t capacity = indexSize / 2;
+
+    SessionTombstoneRing()
+    {
+        index.fill(emptySlot);
+    }
+
+    /**
+     * @brief Record the closed session. If the session is already in the ring
+     *        the recorded reason is kept, except `deleted` which is replaced
+     *        by the more specific `revoked`.
+     *
+     * @param sessionId     - the closed session identifier.
+     * @param reason        - the way the session has been closed.
+     */
+    void record(SessionIdentifier sessionId, SessionCloseReason reason);
+
+    /**
+     * @brief Find the record of the closed session.
+     *
+     * @param sessionId     - the session identifier to look up.
+     *
+     * @return const SessionTombstone* - the session record, nullptr if the
+     *         session isn't in the ring.
+     */
+    const SessionTombstone* find(SessionIdentifier sessionId) const;
+
+  private:
+    /**
+     * @brief Find the index slot pointing to the session record.
+     *
+     * @return std::size_t - the index slot, indexSize if the session isn't in
+     *                       the ring.
+     */
+    std::size_t findSlot(SessionIdentifier sessionId) const;
+
+    /**
+     * @brief Get the preferred index slot of the session.
+     */
+    static std::size_t homeSlot(SessionIdentifier sessionId);
+
+    /**
+     * @brief Drop the session from the index keeping the probe sequences of
+     *        the rest of the records unbroken.
+     */
+    void unindex(SessionIdentifier sessionId);
+
+    std::array<SessionTombstone, capacity> ring{};
+    std::array<std::uint16_t, indexSize> index{};
+    std::size_t head = 0;
+    std::size_t size = 0;
+};
+
+} // namespace session
+} // namespace obmc
@@ -2,15 +2,18 @@
 // Copyright (C) 2021 YADRO
 
 #include <libobmcsession/manager.hpp>
+#include <sdbusplus/exception.hpp>
 #include <sdbusplus/server/object.hpp>
 #include <src/session.hpp>
 #include <xyz/openbmc_project/Object/Delete/client.hpp>
 #include <xyz/openbmc_project/Session/Item/client.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <string_view>
 
 namespace obmc
 {
@@ -19,6 +22,8 @@ namespace session
 
 constexpr const char* sessionManagerObjectPath =
     "/xyz/openbmc_project/session_manager/";
+constexpr const char* resourceNotFoundError =
+    "xyz.openbmc_project.Common.Error.ResourceNotFound";
 
 SessionManager::SessionIdentifier
     SessionManager::create(const std::string& userName,
@@ -26,8 +31,8 @@ SessionManager::SessionIdentifier
 {
     auto sessionId = generateSessionId();
     auto sessionObjectPath = getSessionObjectPath(sessionId);
-    auto session =
-        std::make_unique<SessionItem>(bus, sessionObjectPath, weak_from_this());
+    auto session = std::make_unique<SessionItem>(bus, sessionObjectPath,
+                                                 sessionId, weak_from_this());
 
     session->sessionID(hexSessionId(sessionId));
     session->sessionType(type);
@@ -36,8 +41,10 @@ SessionManager::SessionIdentifier
     if (!userName.empty())
     {
         session->adjustSessionOwner(userName);
+        sessionActivated(*session);
     }
 
+    statistics.created++;
     sessionItems.insert_or_assign(sessionId, std::move(session));
 
     return sessionId;
@@ -69,6 +76,43 @@ SessionManager::SessionIdentifier
     return sessionId;
 }
 
+SessionManager::SessionIdentifier
+    SessionManager::createOrReuse(const std::string& userName,
+                                  const uint32_t remoteAddress,
+                                  const std::string& clientToken)
+{
+    if (userName.empty())
+    {
+        return this->create(userName, remoteAddress);
+    }
+
+    auto fingerprint = std::make_tuple(userName, remoteAddress, clientToken);
+    auto reusableSessionId = findReusableSession(fingerprint);
+    if (reusableSessionId)
+    {
+        statistics.reused++;
+        return *reusableSessionId;
+    }
+
+    auto sessionId = this->create(userName, remoteAddress);
+    auto reusableIt =
+        reusableSessions.emplace(std::move(fingerprint), sessionId).first;
+    sessionFingerprints.insert_or_assign(sessionId, reusableIt);
+    return sessionId;
+}
+
+SessionManager::SessionIdentifier
+    SessionManager::createOrReuse(const std::string& userName,
+                                  const uint32_t remoteAddress,
+                                  const std::string& clientToken,
+                                  SessionCleanupFn&& cleanupFn)
+{
+    auto sessionId = this->createOrReuse(userName, remoteAddress, clientToken);
+    sessionItems.at(sessionId)->appendCleanupFn(
+        std::forward<SessionCleanupFn>(cleanupFn));
+    return sessionId;
+}
+
 void SessionManager::setSessionMetadata(SessionIdentifier sessionId,
                                         const std::string& userName,
                                         const uint32_t remoteAddress)
@@ -106,17 +150,27 @@ void SessionManager::setSessionMetadata(SessionIdentifier sessionId,
 }
 
 bool SessionManager::remove(SessionIdentifier sessionId)
+{
+    return remove(sessionId, SessionCloseReason::removed);
+}
+
+bool SessionManager::remove(SessionIdentifier sessionId,
+                            SessionCloseReason reason)
 {
     auto sessionIt = sessionItems.find(sessionId);
     if (sessionItems.end() == sessionIt)
     {
         return false;
     }
+    statistics.lifetime.record(sessionIt->second->getLifetime());
+    statistics.closed++;
+    forgetClientFingerprint(sessionId);
+    tombstones.record(sessionId, reason);
     sessionItems.erase(sessionIt);
     return true;
 }
 
-std::size_t SessionManager::removeAll(const std::string& userName) const
+std::size_t SessionManager::removeAll(const std::string& userName)
 {
     auto objects = findSessionItemObjects();
     auto userObjectPath = "/xyz/openbmc_project/user/" + userName;
@@ -161,7 +215,7 @@ std::size_t SessionManager::removeAll(const std::string& userName) const
     return handledSessions;
 }
 
-std::size_t SessionManager::removeAll(uint32_t remoteAddress) const
+std::size_t SessionManager::removeAll(uint32_t remoteAddress)
 {
     auto objects = findSessionItemObjects();
     size_t handledSessions = 0;
@@ -197,7 +251,7 @@ std::size_t SessionManager::removeAll(uint32_t remoteAddress) const
     return handledSessions;
 }
 
-std::size_t SessionManager::removeAll(SessionType type) const
+std::size_t SessionManager::removeAll(SessionType type)
 {
     auto objects = findSessionItemObjects();
     size_t handledSessions = 0;
@@ -234,7 +288,7 @@ std::size_t SessionManager::removeAll(SessionType type) const
     return handledSessions;
 }
 
-std::size_t SessionManager::removeAll() const
+std::size_t SessionManager::removeAll()
 {
     auto objects = findSessionItemObjects();
     size_t handledSessions = 0;
@@ -255,6 +309,179 @@ std::size_t SessionManager::removeAll() const
     return handledSessions;
 }
 
+std::optional<SessionTombstone>
+    SessionManager::findClosedSession(SessionIdentifier sessionId) const
+{
+    const SessionTombstone* tombstone = tombstones.find(sessionId);
+    if (tombstone == nullptr)
+    {
+        return std::nullopt;
+    }
+    return *tombstone;
+}
+
+SessionStatistics SessionManager::getStatistics() const
+{
+    SessionStatistics snapshot = statistics;
+    snapshot.active = sessionItems.size();
+    snapshot.observed = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - statisticsSince);
+    return snapshot;
+}
+
+void SessionManager::resetStatistics()
+{
+    statistics = SessionStatistics{};
+    statistics.type = type;
+    statisticsSince = std::chrono::steady_clock::now();
+}
+
+void SessionManager::sessionActivated(SessionItem& session)
+{
+    auto timeToActivation = session.activate();
+    if (timeToActivation)
+    {
+        statistics.activation.record(*timeToActivation);
+        statistics.activated++;
+    }
+}
+
+std::optional<SessionManager::SessionIdentifier>
+    SessionManager::findReusableSession(
+        const ClientFingerprint& fingerprint) const
+{
+    auto reusableIt = reusableSessions.find(fingerprint);
+    if (reusableSessions.end() == reusableIt)
+    {
+        return std::nullopt;
+    }
+    return reusableIt->second;
+}
+
+void SessionManager::forgetClientFingerprint(SessionIdentifier sessionId)
+{
+    auto fingerprintIt = sessionFingerprints.find(sessionId);
+    if (sessionFingerprints.end() == fingerprintIt)
+    {
+        return;
+    }
+    reusableSessions.erase(fingerprintIt->second);
+    sessionFingerprints.erase(fingerprintIt);
+}
+
+ScrubReport SessionManager::scrub(const ScrubBudget& budget)
+{
+    ScrubReport report;
+    auto startTime = std::chrono::steady_clock::now();
+
+    if (!scrubPassInProgress)
+    {
+        if (scrubPassEnd && startTime - *scrubPassEnd < budget.passInterval)
+        {
+            return report;
+        }
+        scrubPassInProgress = true;
+        scrubCursor = 0;
+        scrubOrphansPending = false;
+    }
+
+    // The step duration only limits starting the next check, a single mapper
+    // reply may take longer on a loaded system.
+    auto withinBudget = [&budget, &report, startTime]() {
+        return report.roundTrips < budget.roundTrips &&
+               std::chrono::steady_clock::now() - startTime < budget.duration;
+    };
+    const auto callTimeoutUs = static_cast<uint64_t>(
+        std::max(budget.callTimeout, ScrubBudget::minCallTimeout).count());
+
+    auto sessionIt = sessionItems.lower_bound(scrubCursor);
+    while (!scrubOrphansPending && sessionItems.end() != sessionIt)
+    {
+        if (report.checked >= budget.sessions || !withinBudget())
+        {
+            report.budgetExhausted = true;
+            break;
+        }
+
+        const auto& [sessionId, session] = *sessionIt;
+
+        bool mapped = false;
+        report.roundTrips++;
+        try
+        {
+            mapped = isSessionObjectMapped(getSessionObjectPath(sessionId),
+                                           callTimeoutUs);
+        }
+        catch (const std::exception&)
+        {
+            report.mapperUnavailable = true;
+            break;
+        }
+        if (!mapped)
+        {
+            session->republish();
+            report.republished++;
+        }
+
+        report.checked++;
+        sessionIt++;
+    }
+
+    if (!scrubOrphansPending)
+    {
+        if (sessionItems.end() != sessionIt)
+        {
+            scrubCursor = sessionIt->first;
+            return report;
+        }
+        scrubOrphansPending = true;
+    }
+
+    if (report.mapperUnavailable)
+    {
+        return report;
+    }
+    if (!withinBudget())
+    {
+        report.budgetExhausted = true;
+        return report;
+    }
+
+    DBusSubTreeOut objects;
+    report.roundTrips++;
+    try
+    {
+        objects = findOwnSessionItemObjects(callTimeoutUs);
+    }
+    catch (const std::exception&)
+    {
+        report.mapperUnavailable = true;
+        return report;
+    }
+
+    const auto ownPathPrefix = getSessionManagerObjectPath() + "/";
+    for (const auto& [sessionObjectPath, objectMetaDict] : objects)
+    {
+        auto serviceIt = objectMetaDict.find(serviceName);
+        if (objectMetaDict.end() == serviceIt ||
+            !sessionObjectPath.starts_with(ownPathPrefix) ||
+            findOwnSessionId(sessionObjectPath))
+        {
+            continue;
+        }
+        // The object isn't served by the current manager anymore, so make
+        // the mapper forget it.
+        bus.emit_interfaces_removed(sessionObjectPath.c_str(),
+                                    serviceIt->second);
+        report.orphansRemoved++;
+    }
+
+    scrubPassInProgress = false;
+    scrubPassEnd = std::chrono::steady_clock::now();
+    report.passCompleted = true;
+    return report;
+}
+
 SessionManager::SessionIdentifier SessionManager::generateSessionId() const
 {
     auto time = std::chrono::high_resolution_clock::now();
@@ -307,9 +534,76 @@ const SessionManager::DBusSubTreeOut
     return std::forward<DBusSubTreeOut>(getSessionItemObjects);
 }
 
+bool SessionManager::isSessionObjectMapped(const std::string& objectPath,
+                                           uint64_t timeoutUs) const
+{
+    using DBusGetObjectOut = std::map<std::string, std::vector<std::string>>;
+
+    constexpr const std::array sessionItemObjectIfaces = {
+        "xyz.openbmc_project.Session.Item"};
+
+    DBusGetObjectOut getSessionObject;
+    try
+    {
+        auto callMethod = bus.new_method_call(
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetObject");
+        callMethod.append(objectPath.c_str(), sessionItemObjectIfaces);
+        bus.call(callMethod, timeoutUs).read(getSessionObject);
+    }
+    catch (const sdbusplus::exception::exception& e)
+    {
+        if (resourceNotFoundError == std::string_view(e.name()))
+        {
+            return false;
+        }
+        throw;
+    }
+
+    return getSessionObject.contains(serviceName);
+}
+
+const SessionManager::DBusSubTreeOut
+    SessionManager::findOwnSessionItemObjects(uint64_t timeoutUs) const
+{
+    constexpr const std::array sessionItemObjectIfaces = {
+        "xyz.openbmc_project.Session.Item"};
+
+    DBusSubTreeOut getSessionItemObjects;
+    try
+    {
+        auto callMethod = bus.new_method_call(
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetSubTree");
+        callMethod.append(getSessionManagerObjectPath(), 0U,
+                          sessionItemObjectIfaces);
+        bus.call(callMethod, timeoutUs).read(getSessionItemObjects);
+    }
+    catch (const sdbusplus::exception::exception& e)
+    {
+        if (resourceNotFoundError != std::string_view(e.name()))
+        {
+            throw;
+        }
+    }
+
+    return std::forward<DBusSubTreeOut>(getSessionItemObjects);
+}
+
 void SessionManager::callCloseSession(const std::string& serviceName,
-                                      const std::string& objectPath) const
+                                      const std::string& objectPath)
 {
+    // The own sessions are served by the same connection, so they can't be
+    // closed by a dbus call.
+    auto sessionId = findOwnSessionId(objectPath);
+    if (sessionId)
+    {
+        remove(*sessionId, SessionCloseReason::revoked);
+        return;
+    }
+
     std::vector<std::string> getSessionItemObjects;
     auto callMethod = bus.new_method_call(
         serviceName.c_str(), objectPath.c_str(),
@@ -327,6 +621,19 @@ const SessionManager::DBusSessionDetailsMap
 
     SessionManager::DBusSessionDetailsMap sessionDetails;
 
+    auto sessionId = findOwnSessionId(objectPath);
+    if (sessionId)
+    {
+        const auto& session = sessionItems.at(*sessionId);
+        sessionDetails.emplace("SessionID", session->sessionID());
+        sessionDetails.emplace("SessionType",
+                               sdbusplus::message::details::convert_to_string(
+                                   session->sessionType()));
+        sessionDetails.emplace("RemoteIPAddr", session->remoteIPAddr());
+        sessionDetails.emplace("Associations", session->associations());
+        return sessionDetails;
+    }
+
     auto callMethod =
         bus.new_method_call(serviceName.c_str(), objectPath.c_str(),
                             "org.freedesktop.DBus.Properties", "GetAll");
@@ -336,5 +643,31 @@ const SessionManager::DBusSessionDetailsMap
     return std::forward<SessionManager::DBusSessionDetailsMap>(sessionDetails);
 }
 
+std::optional<SessionManager::SessionIdentifier>
+    SessionManager::findOwnSessionId(const std::string& objectPath) const
+{
+    const auto ownPathPrefix = getSessionManagerObjectPath() + "/";
+    if (!objectPath.starts_with(ownPathPrefix))
+    {
+        return std::nullopt;
+    }
+
+    SessionIdentifier sessionId;
+    try
+    {
+        sessionId = parseSessionId(objectPath.substr(ownPathPrefix.size()));
+    }
+    catch (const std::exception&)
+    {
+        return std::nullopt;
+    }
+
+    if (!sessionItems.contains(sessionId))
+    {
+        return std::nullopt;
+    }
+    return sessionId;
+}
+
 } // namespace session
 } // namespace obmc
@@ -14,7 +14,7 @@ void SessionItem::delete_()
     {
         SessionManager::SessionIdentifier sessionId =
             SessionManager::parseSessionId(this->sessionID());
-        if (!manager->remove(sessionId))
+        if (!manager->remove(sessionId, SessionCloseReason::deleted))
         {
             throw InternalFailure();
         }
@@ -26,6 +26,15 @@ void SessionItem::setSessionMetadata(std::string username,
 {
     this->adjustSessionOwner(username);
     this->remoteIPAddr(remoteIPAddr);
+
+    auto manager = managerWeakPtr.lock();
+    if (manager)
+    {
+        manager->sessionActivated(*this);
+        // The session owner might be changed, so the session can't be
+        // reused by its initial client anymore.
+        manager->forgetClientFingerprint(identifier);
+    }
 }
 
 void SessionItem::resetCleanupFn(SessionManager::SessionCleanupFn&& cleanup)
@@ -33,6 +42,23 @@ void SessionItem::resetCleanupFn(SessionManager::SessionCleanupFn&& cleanup)
     this->cleanupFn = cleanup;
 }
 
+void SessionItem::appendCleanupFn(SessionManager::SessionCleanupFn&& cleanup)
+{
+    if (this->cleanupFn == nullptr)
+    {
+        this->cleanupFn = std::move(cleanup);
+        return;
+    }
+
+    this->cleanupFn = [previous = std::move(this->cleanupFn),
+                       next = std::move(cleanup)](
+                          SessionManager::SessionIdentifier sessionId) {
+        bool previousResult = std::invoke(previous, sessionId);
+        bool nextResult = std::invoke(next, sessionId);
+        return previousResult && nextResult;
+    };
+}
+
 void SessionItem::adjustSessionOwner(const std::string& userName)
 {
     using DBusGetObjectOut = std::map<std::string, std::vector<std::string>>;
@@ -60,5 +86,26 @@ void SessionItem::adjustSessionOwner(const std::string& userName)
     });
 }
 
+std::chrono::milliseconds SessionItem::getLifetime() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - creationTime);
+}
+
+std::optional<std::chrono::milliseconds> SessionItem::activate()
+{
+    if (activated)
+    {
+        return std::nullopt;
+    }
+    activated = true;
+    return getLifetime();
+}
+
+void SessionItem::republish()
+{
+    bus.emit_object_added(path.c_str());
+}
+
 } // namespace session
 } // namespace obmc
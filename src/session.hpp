@@ -10,6 +10,9 @@
 #include <xyz/openbmc_project/Common/error.hpp>
 #include <xyz/openbmc_project/Object/Delete/server.hpp>
 
+#include <chrono>
+#include <optional>
+
 namespace obmc
 {
 namespace session
@@ -41,14 +44,17 @@ class SessionItem :
      *
      * @param[in] bus               - Handle to system dbus
      * @param[in] objPath           - The Dbus path that hosts Session Item.
+     * @param[in] sessionId         - The session identifier.
      * @param[in] managerWeakPtr    - The weakptr of manager.
      */
     SessionItem(sdbusplus::bus::bus& bus, const std::string& objPath,
+                SessionManager::SessionIdentifier sessionId,
                 SessionManagerWeakPtr managerWeakPtr) :
         SessionItemServerObject(bus, objPath.c_str()),
         AssocDefinitionServerObject(bus, objPath.c_str()),
-        DeleteServerObject(bus, objPath.c_str()), bus(bus), path(objPath),
-        managerWeakPtr(managerWeakPtr)
+        DeleteServerObject(bus, objPath.c_str()), identifier(sessionId),
+        bus(bus), path(objPath), managerWeakPtr(managerWeakPtr),
+        creationTime(std::chrono::steady_clock::now())
     {
         // Nothing to do here
     }
@@ -57,17 +63,20 @@ class SessionItem :
      *
      * @param[in] bus           - Handle to system dbus
      * @param[in] objPath       - The Dbus path that hosts Session Item
+     * @param[in] sessionId     - The session identifier.
      * @param[in] cleanupFn     - The callback will be handling a customized
      *                            cleanup of the session on the session-item
      *                            removal.
      */
     SessionItem(sdbusplus::bus::bus& bus, const std::string& objPath,
+                SessionManager::SessionIdentifier sessionId,
                 SessionManagerWeakPtr managerWeakPtr,
                 SessionManager::SessionCleanupFn&& cleanupFn) :
         SessionItemServerObject(bus, objPath.c_str()),
         AssocDefinitionServerObject(bus, objPath.c_str()),
-        DeleteServerObject(bus, objPath.c_str()), bus(bus), path(objPath),
-        managerWeakPtr(managerWeakPtr), cleanupFn(cleanupFn)
+        DeleteServerObject(bus, objPath.c_str()), identifier(sessionId),
+        bus(bus), path(objPath), managerWeakPtr(managerWeakPtr),
+        cleanupFn(cleanupFn), creationTime(std::chrono::steady_clock::now())
     {
         // Nothing to do here
     }
@@ -102,6 +111,13 @@ class SessionItem :
      */
     void resetCleanupFn(SessionManager::SessionCleanupFn&&);
 
+    /**
+     * @brief Add the callback to be called after the already set ones on the
+     *        session close.
+     *
+     */
+    void appendCleanupFn(SessionManager::SessionCleanupFn&&);
+
     /**
      * @brief Associate user of specified UID with the current session.
      *
@@ -113,6 +129,27 @@ class SessionItem :
      */
     void adjustSessionOwner(const std::string& userName);
 
+    /**
+     * @brief Get the time elapsed since the session item creation.
+     *
+     * @return std::chrono::milliseconds - the session lifetime.
+     */
+    std::chrono::milliseconds getLifetime() const;
+
+    /**
+     * @brief Mark the session as activated.
+     *
+     * @return std::optional<std::chrono::milliseconds> - the time elapsed from
+     *         the session creation till the activation, std::nullopt if the
+     *         session has been already activated.
+     */
+    std::optional<std::chrono::milliseconds> activate();
+
+    /**
+     * @brief Announce the session object on the dbus again.
+     */
+    void republish();
+
   private:
     SessionManager::SessionIdentifier identifier;
     sdbusplus::bus::bus& bus;
@@ -120,6 +157,8 @@ class SessionItem :
     const std::string path;
     SessionManagerWeakPtr managerWeakPtr;
     SessionManager::SessionCleanupFn cleanupFn;
+    std::chrono::steady_clock::time_point creationTime;
+    bool activated = false;
 };
 
 } // namespace session
@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2021 YADRO
+
+#include <libobmcsession/statistics.hpp>
+
+#include <algorithm>
+
+namespace obmc
+{
+namespace session
+{
+
+void DurationHistogram::record(Duration duration)
+{
+    std::size_t bucket = 0;
+    while (bucket < bucketsCount - 1 && duration >= bucketUpperBound(bucket))
+    {
+        bucket++;
+    }
+    buckets[bucket]++;
+
+    min = count == 0 ? duration : std::min(min, duration);
+    count++;
+    total += duration;
+    max = std::max(max, duration);
+}
+
+DurationHistogram::Duration
+    DurationHistogram::bucketUpperBound(std::size_t bucket)
+{
+    if (bucket >= bucketsCount - 1)
+    {
+        return Duration::max();
+    }
+    return Duration(1LL << bucket);
+}
+
+DurationHistogram::Duration DurationHistogram::mean() const
+{
+    if (count == 0)
+    {
+        return Duration::zero();
+    }
+    return total / static_cast<Duration::rep>(count);
+}
+
+double SessionStatistics::churnRate() const
+{
+    using Minutes = std::chrono::duration<double, std::ratio<60>>;
+
+    auto minutes = std::chrono::duration_cast<Minutes>(observed).count();
+    if (minutes <= 0)
+    {
+        return 0;
+    }
+    return static_cast<double>(closed) / minutes;
+}
+
+} // namespace session
+} // namespace obmc
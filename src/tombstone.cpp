@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright (C) 2021 YADRO
+
+#include <libobmcsession/tombstone.hpp>
+
+namespace obmc
+{
+namespace session
+{
+
+void SessionTombstoneRing::record(SessionIdentifier sessionId,
+                                  SessionCloseReason reason)
+{
+    auto recordedSlot = findSlot(sessionId);
+    if (recordedSlot != indexSize)
+    {
+        auto& tombstone = ring[index[recordedSlot]];
+        if (tombstone.reason == SessionCloseReason::deleted &&
+            reason == SessionCloseReason::revoked)
+        {
+            tombstone.reason = reason;
+        }
+        return;
+    }
+
+    if (size == capacity)
+    {
+        unindex(ring[head].sessionId);
+    }
+    else
+    {
+        size++;
+    }
+    ring[head] = {sessionId, reason, std::chrono::steady_clock::now()};
+
+    auto slot = homeSlot(sessionId);
+    while (index[slot] != emptySlot)
+    {
+        slot = (slot + 1) % indexSize;
+    }
+    index[slot] = static_cast<std::uint16_t>(head);
+
+    head = (head + 1) % capacity;
+}
+
+const SessionTombstone*
+    SessionTombstoneRing::find(SessionIdentifier sessionId) const
+{
+    auto slot = findSlot(sessionId);
+    if (slot == indexSize)
+    {
+        return nullptr;
+    }
+    return &ring[index[slot]];
+}
+
+std::size_t SessionTombstoneRing::findSlot(SessionIdentifier sessionId) const
+{
+    for (auto slot = homeSlot(sessionId); index[slot] != emptySlot;
+         slot = (slot + 1) % indexSize)
+    {
+        if (ring[index[slot]].sessionId == sessionId)
+        {
+            return slot;
+        }
+    }
+    return indexSize;
+}
+
+std::size_t SessionTombstoneRing::homeSlot(SessionIdentifier sessionId)
+{
+    // Fibonacci hashing spreads the sequential identifiers as well.
+    constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+    return static_cast<std::size_t>((sessionId * multiplier) >>
+                                    (64 - indexBits));
+}
+
+void SessionTombstoneRing::unindex(SessionIdentifier sessionId)
+{
+    auto hole = findSlot(sessionId);
+    if (hole == indexSize)
+    {
+        return;
+    }
+    index[hole] = emptySlot;
+
+    // Shift back the records of the same probe sequence to fill the hole.
+    for (auto slot = (hole + 1) % indexSize; index[slot] != emptySlot;
+         slot = (slot + 1) % indexSize)
+    {
+        auto home = homeSlot(ring[index[slot]].sessionId);
+        auto distanceToHole = (hole - home + indexSize) % indexSize;
+        auto distanceToSlot = (slot - home + indexSize) % indexSize;
+        if (distanceToHole < distanceToSlot)
+        {
+            index[hole] = index[slot];
+            index[slot] = emptySlot;
+            hole = slot;
+        }
+    }
+}
+
+} // namespace session
+} // namespace obmc